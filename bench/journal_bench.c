@@ -0,0 +1,117 @@
+/* bench/journal_bench.c - tempo di recovery del journal (exec/journal.c)
+ *
+ *   journal_bench <conf> <dir> gen <record> [una ogni N resta attiva, default 50]
+ *   journal_bench <conf> <dir> open
+ *
+ * "gen" scrive un segmento sintetico passando dalle stesse funzioni del server
+ * (registerEmergency / unregisterEmergency / journalTwin): ogni emergenza produce
+ * due record, la registrazione e la rimozione, oppure per le superstiti un
+ * movimento di un twin. Nessuna compattazione: tutto resta in un segmento.
+ * "open", in un processo nuovo, misura journalOpen (replay + snapshot fresco).
+ * La riga "[JOURNAL] Recovery" con il solo tempo di replay finisce in bench/bench.log.
+ * "make bench-journal" esegue entrambi con 1M record.
+ */
+#include "server.h"
+#include "journal.h"
+#include "scheduler.h"
+#include "dedup.h"
+#include "shard.h"
+#include <string.h>
+#include <time.h>
+
+struct emergencyServer server;
+
+static double elapsedMs(const struct timespec *t0) {
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0->tv_sec) * 1e3 + (t1.tv_nsec - t0->tv_nsec) / 1e6;
+}
+
+/* Lo stretto necessario di initServer + loadServerConfig (main.c) */
+static void benchSetup(const char *conf_dir) {
+    mtx_init(&server.twins_mtx, mtx_plain);
+    mtx_init(&server.active_mtx, mtx_plain);
+    mtx_init(&server.conf_mtx, mtx_plain);
+    server.active_cap = MAX_ACTIVE_CAP;
+    SAFE_MALLOC(server.active_emergencies, sizeof(emergency_t*) * server.active_cap);
+    atomic_init(&server.next_em_seq, 1);
+    atomic_init(&server.pending_conf, NULL);
+    server.sock_fd = -1;
+    server.reply_efd = -1;
+    mpsc_init(&server.replies);
+    mpsc_init(&server.ingest);
+    em_table_init(&server.em_index, 1024);
+
+    conf_gen_t *g = confLoad(conf_dir, 1);
+    if (!g) {
+        fprintf(stderr, "journal_bench: invalid configuration in %s\n", conf_dir);
+        exit(1);
+    }
+    server.env_config = env_copy(&g->env);
+    server.conf_path = conf_dir;
+    confInstall(g);
+    dedupInit(0, 0);
+    shardsInit();
+}
+
+static void benchGen(const char *dir, long records, int live_every) {
+    if (journalOpen(dir) != 0) {
+        fprintf(stderr, "journal_bench: cannot open journal in %s\n", dir);
+        exit(1);
+    }
+    emergency_type_t *type = &server.conf->em_data.types[0];
+    emergency_request_t req = { .timestamp = time(NULL) };
+    snprintf(req.emergency_name, sizeof(req.emergency_name), "%s", type->emergency_desc);
+
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    long live = 0;
+    for (long i = 0; i < records / 2; i++) {
+        req.x = (int)(i % server.env_config.width);
+        req.y = (int)(i / server.env_config.width % server.env_config.height);
+        emergency_t *em = createEmergencyFromRequest(&req);
+        if (!em) exit(1);
+        registerEmergency(em);
+        if (i % live_every) {
+            unregisterEmergency(em);
+            freeEmergency(em);
+        } else {
+            journalTwin(&server.twins[i % server.twins_count]);
+            live++;
+        }
+    }
+    journalClose();
+    printf("gen: %ld records, %ld emergencies still active, written in %.1f ms\n",
+           records / 2 * 2, live, elapsedMs(&t0));
+}
+
+static void benchOpen(const char *dir) {
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (journalOpen(dir) != 0) {
+        fprintf(stderr, "journal_bench: cannot open journal in %s\n", dir);
+        exit(1);
+    }
+    double ms = elapsedMs(&t0);
+    printf("open: %d emergencies resumed, journalOpen %.1f ms (replay time in bench/bench.log)\n",
+           server.active_count, ms);
+    journalClose();
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4 || (strcmp(argv[3], "gen") == 0 && argc < 5)) {
+        fprintf(stderr, "usage: %s <conf> <dir> gen <records> [live_every]\n"
+                        "       %s <conf> <dir> open\n", argv[0], argv[0]);
+        return 1;
+    }
+    init_logger("bench/bench.log");
+    benchSetup(argv[1]);
+
+    if (strcmp(argv[3], "gen") == 0) {
+        int live_every = argc > 5 ? atoi(argv[5]) : 50;
+        benchGen(argv[2], atol(argv[4]), live_every > 0 ? live_every : 50);
+    } else {
+        benchOpen(argv[2]);
+    }
+    return 0;
+}
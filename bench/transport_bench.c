@@ -0,0 +1,120 @@
+/* bench/transport_bench.c - coda POSIX contro anello in memoria condivisa (exec/shm_ring.c)
+ *
+ *   transport_bench <mq|shm> [messaggi, default 1000000] [pausa_us, default 0]
+ *
+ * Un produttore (thread principale) e un consumatore nello stesso processo, con lo
+ * stesso protocollo di attesa del server: mq_receive bloccante sulla coda (profonda
+ * 10 come quelle del server), shm_ring_pop + shm_ring_wait sull'anello.
+ * Ogni richiesta porta in timestamp l'istante di invio (ns): il consumatore ne
+ * ricava la latenza. Con pausa 0 si misura il throughput a saturazione (la latenza
+ * è soprattutto attesa in coda), con una pausa la latenza di una richiesta isolata.
+ * "make bench-transport" esegue i due trasporti in entrambi i modi.
+ */
+#include "shm_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include <mqueue.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+static struct {
+    int shm;
+    int ring;   // anello preso con shm_ring_claim
+    long count;
+    long *lat_ns;
+    mqd_t mq;
+    shm_region_t *reg;
+    char name[64];
+} g_tb;
+
+static long nowNs(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000L + t.tv_nsec;
+}
+
+static int consumer(void *arg) {
+    (void)arg;
+    emergency_request_t req;
+    char buf[BATCH_MSG_SIZE];
+    for (long i = 0; i < g_tb.count; ) {
+        if (g_tb.shm) {
+            if (shm_ring_pop(&g_tb.reg->ring[g_tb.ring], &req)) g_tb.lat_ns[i++] = nowNs() - (long)req.timestamp;
+            else shm_ring_wait(g_tb.reg, 0, 1000);
+        } else if (mq_receive(g_tb.mq, buf, sizeof(buf), NULL) >= (ssize_t)sizeof(req)) {
+            memcpy(&req, buf, sizeof(req));
+            g_tb.lat_ns[i++] = nowNs() - (long)req.timestamp;
+        }
+    }
+    return 0;
+}
+
+static int cmpLong(const void *a, const void *b) {
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || (strcmp(argv[1], "mq") != 0 && strcmp(argv[1], "shm") != 0)) {
+        fprintf(stderr, "usage: %s <mq|shm> [messages] [pace_us]\n", argv[0]);
+        return 1;
+    }
+    g_tb.shm = strcmp(argv[1], "shm") == 0;
+    g_tb.count = argc > 2 ? atol(argv[2]) : 1000000;
+    long pace_ns = argc > 3 ? atol(argv[3]) * 1000L : 0;
+    if (g_tb.count <= 0) return 1;
+    g_tb.lat_ns = malloc(sizeof(long) * (size_t)g_tb.count);
+    if (!g_tb.lat_ns) return 1;
+
+    snprintf(g_tb.name, sizeof(g_tb.name), "/transport_bench.%d", (int)getpid());
+    if (g_tb.shm) {
+        g_tb.reg = shm_region_create(g_tb.name, 1);
+        if (!g_tb.reg || !shm_ring_claim(g_tb.reg, &g_tb.ring)) {
+            perror("shm_region_create");
+            return 1;
+        }
+    } else {
+        struct mq_attr attr = { .mq_maxmsg = 10, .mq_msgsize = BATCH_MSG_SIZE };
+        g_tb.mq = mq_open(g_tb.name, O_CREAT | O_RDWR, 0600, &attr);
+        if (g_tb.mq == (mqd_t)-1) {
+            perror("mq_open");
+            return 1;
+        }
+    }
+
+    thrd_t t;
+    thrd_create(&t, consumer, NULL);
+    emergency_request_t req = { .x = 1, .y = 1 };
+    snprintf(req.emergency_name, sizeof(req.emergency_name), "Frana");
+
+    long t0 = nowNs();
+    for (long i = 0; i < g_tb.count; i++) {
+        if (pace_ns) {
+            long until = nowNs() + pace_ns;
+            while (nowNs() < until)
+                ;
+        }
+        req.timestamp = nowNs();
+        if (g_tb.shm) shm_ring_push(g_tb.reg, g_tb.ring, &req);
+        else mq_send(g_tb.mq, (const char *)&req, sizeof(req), 0);
+    }
+    thrd_join(t, NULL);
+    long elapsed = nowNs() - t0;
+
+    qsort(g_tb.lat_ns, (size_t)g_tb.count, sizeof(long), cmpLong);
+    printf("%-3s pace %4ld us: %ld msgs, %.2f M msgs/s, latency p50 %.1f us, p99 %.1f us\n",
+           argv[1], pace_ns / 1000, g_tb.count, g_tb.count / (elapsed / 1e9) / 1e6,
+           g_tb.lat_ns[g_tb.count / 2] / 1e3, g_tb.lat_ns[g_tb.count * 99 / 100] / 1e3);
+
+    if (g_tb.shm) {
+        shm_region_destroy(g_tb.reg, g_tb.name);
+    } else {
+        mq_close(g_tb.mq);
+        mq_unlink(g_tb.name);
+    }
+    free(g_tb.lat_ns);
+    return 0;
+}
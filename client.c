@@ -6,6 +6,11 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <time.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 #include "server.h"
 #include "logger.h"
@@ -13,30 +18,85 @@
 #include "struct.h"
 #include "parse_env.h"
 #include "utils.h"
+#include "shm_ring.h"
 
+/* Batch in costruzione per uno shard (client -b) */
 typedef struct {
-    mqd_t mq;             // (mqd_t)-1 se non aperta
+    char names[BATCH_MAX_TYPES][EMERGENCY_NAME_LENGTH];
+    int n_names;
+    int names_len;         // byte del dizionario, '\0' inclusi
+    batch_entry_t *entries;
+    int count;
+    time_t base;           // timestamp della prima richiesta
+} batch_t;
+
+typedef struct {
+    mqd_t mqs[MAX_QUEUES]; // una per shard, (mqd_t)-1 se non aperta
+    int mq_count;
+    int round_robin;       // 1: shard a rotazione, 0: hash delle coordinate
+    unsigned next_shard;
     env_config_t config;  // contiene queue_name 
     int logger_init;      // 1 se init_logger effettuato
+    batch_t *batches;     // uno per shard, solo con -b
+    int batch_max;        // richieste per messaggio
+    size_t msgsize;       // mq_msgsize delle code
+    int sent_msgs;
+    shm_region_t *shm;    // transport=shm: regione del server e anello preso
+    int ring;
 } client_res_t;
 
 static void res_init(client_res_t *r) {
-    r->mq = (mqd_t)-1;
+    r->mq_count = 0;
+    r->round_robin = 0;
+    r->next_shard = 0;
     r->logger_init = 0;
+    r->batches = NULL;
+    r->sent_msgs = 0;
+    r->shm = NULL;
+    r->ring = -1;
 }
 
 static void res_cleanup(client_res_t *r) {
-    if (r->mq != (mqd_t)-1) {
-        mq_close(r->mq);
-        r->mq = (mqd_t)-1;
+    for (int i = 0; i < r->mq_count; i++) {
+        if (r->mqs[i] != (mqd_t)-1) mq_close(r->mqs[i]);
+        r->mqs[i] = (mqd_t)-1;
+    }
+    if (r->shm) {
+        if (r->ring >= 0) shm_ring_release(&r->shm->ring[r->ring]);
+        shm_region_detach(r->shm);
+        r->shm = NULL;
+    }
+    if (r->batches) {
+        for (int i = 0; i < MAX_QUEUES; i++) free(r->batches[i].entries);
+        free(r->batches);
+        r->batches = NULL;
     }
+    r->mq_count = 0;
     if (r->logger_init) {
         close_logger();
         r->logger_init = 0;
     }
 }
 
-static int invia_emergenza(mqd_t mq, const char *nome, int x, int y, int delay) {
+/* Shard di destinazione: hash delle coordinate (la stessa zona va sempre
+ * sullo stesso listener) oppure round-robin con -r.
+ */
+static unsigned scegli_shard(client_res_t *r, int x, int y) {
+    unsigned shard;
+    if (r->round_robin) {
+        shard = r->next_shard++;
+    } else {
+        unsigned h = (unsigned)x * 0x9E3779B1u ^ (unsigned)y * 0x85EBCA77u;
+        shard = h ^ (h >> 16);
+    }
+    return shard % (unsigned)r->mq_count;
+}
+
+static mqd_t scegli_coda(client_res_t *r, int x, int y) {
+    return r->mqs[scegli_shard(r, x, y)];
+}
+
+static int invia_emergenza(client_res_t *r, const char *nome, int x, int y, int delay) {
     emergency_request_t req;
     // Copia sicura del nome (EMERGENCY_NAME_LENGTH include lo '\0')
     snprintf(req.emergency_name, EMERGENCY_NAME_LENGTH, "%s", nome);
@@ -44,7 +104,9 @@ static int invia_emergenza(mqd_t mq, const char *nome, int x, int y, int delay)
     req.x = x;
     req.y = y;
     req.timestamp = time(NULL) + delay;
-    if (mq_send(mq, (const char*)&req, sizeof(req), 0) == -1) {
+    if (r->shm) {
+        shm_ring_push(r->shm, r->ring, &req); // nessuna syscall se il server è sveglio
+    } else if (mq_send(scegli_coda(r, x, y), (const char*)&req, sizeof(req), 0) == -1) {
         perror("mq_send");
         return -1;
     }
@@ -53,7 +115,7 @@ static int invia_emergenza(mqd_t mq, const char *nome, int x, int y, int delay)
     return 0;
 }
 
-static int invia_da_file(mqd_t mq, const char *filename) {
+static int invia_da_file(client_res_t *r, const char *filename) {
     FILE *fp;
     SAFE_FOPEN(fp, filename, "r", filename);
     // Se la tua SAFE_FOPEN fa exit() non si arriva qui; se invece restituisce NULL:
@@ -71,7 +133,7 @@ static int invia_da_file(mqd_t mq, const char *filename) {
         // Limite per 'nome' per evitare overflow
         if (sscanf(line, "%63s %d %d %d", nome, &x, &y, &delay) == 4) {
             if (is_valid_coordinate(x, y) && is_valid_delay(delay) && is_nonempty_string(nome)) {
-                if (invia_emergenza(mq, nome, x, y, delay) != 0) {
+                if (invia_emergenza(r, nome, x, y, delay) != 0) {
                     rc = -1; // fallito un invio: segnalo ma continuo
                 }
                 sleep(1); // piccola pausa per evitare congestione
@@ -88,6 +150,317 @@ static int invia_da_file(mqd_t mq, const char *filename) {
     return rc;
 }
 
+/* ------------------------------------------------------------------ batch */
+
+static size_t batch_bytes(int names_len, int count) {
+    return sizeof(batch_header_t) + (((size_t)names_len + 3) & ~(size_t)3) + (size_t)count * sizeof(batch_entry_t);
+}
+
+static int invia_batch(client_res_t *r, int shard) {
+    batch_t *b = &r->batches[shard];
+    if (b->count == 0) return 0;
+
+    char msg[BATCH_MSG_SIZE];
+    memset(msg, 0, sizeof(msg));
+    batch_header_t h = {
+        .magic = BATCH_MAGIC,
+        .count = (uint16_t)b->count,
+        .names_len = (uint16_t)b->names_len,
+        .timestamp = (int64_t)b->base,
+    };
+    memcpy(msg, &h, sizeof(h));
+    char *p = msg + sizeof(h);
+    for (int i = 0; i < b->n_names; i++) {
+        size_t l = strlen(b->names[i]) + 1;
+        memcpy(p, b->names[i], l);
+        p += l;
+    }
+    size_t len = batch_bytes(b->names_len, b->count);
+    memcpy(msg + len - (size_t)b->count * sizeof(batch_entry_t), b->entries, (size_t)b->count * sizeof(batch_entry_t));
+
+    int rc = 0;
+    if (mq_send(r->mqs[shard], msg, len, 0) == -1) {
+        perror("mq_send");
+        rc = -1;
+    } else {
+        r->sent_msgs++;
+    }
+    b->count = 0;
+    b->n_names = 0;
+    b->names_len = 0;
+    return rc;
+}
+
+/* Accoda una richiesta nel batch del suo shard; spedisce quando il messaggio è pieno */
+static int accoda_batch(client_res_t *r, const char *nome, int x, int y, int delay) {
+    int shard = (int)scegli_shard(r, x, y);
+    batch_t *b = &r->batches[shard];
+    int rc = 0;
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (b->count == 0) b->base = time(NULL);
+        int t;
+        for (t = 0; t < b->n_names; t++)
+            if (strcmp(b->names[t], nome) == 0) break;
+        int names_len = b->names_len + (t == b->n_names ? (int)strlen(nome) + 1 : 0);
+
+        if (b->count < r->batch_max && (t < b->n_names || t < BATCH_MAX_TYPES) &&
+            batch_bytes(names_len, b->count + 1) <= r->msgsize) {
+            if (t == b->n_names) {
+                snprintf(b->names[t], EMERGENCY_NAME_LENGTH, "%s", nome);
+                b->n_names++;
+                b->names_len = names_len;
+            }
+            b->entries[b->count++] = (batch_entry_t){
+                .x = x, .y = y,
+                .delay = (int32_t)(time(NULL) + delay - b->base),
+                .type = (uint8_t)t,
+            };
+            return rc;
+        }
+        if (invia_batch(r, shard) != 0) rc = -1; // pieno: si spedisce e si riprova
+    }
+    fprintf(stderr, "Richiesta troppo grande per un batch: %s\n", nome);
+    return -1;
+}
+
+/* -b: come -f ma senza pause, K richieste per messaggio.
+ * Con transport=shm i record vanno direttamente nell'anello, uno per richiesta.
+ */
+static int invia_da_file_batch(client_res_t *r, const char *filename, int k) {
+    if (r->shm) {
+        r->batch_max = 1;
+    } else {
+        struct mq_attr attr;
+        if (mq_getattr(r->mqs[0], &attr) == -1) {
+            perror("mq_getattr");
+            return -1;
+        }
+        r->msgsize = (size_t)attr.mq_msgsize < BATCH_MSG_SIZE ? (size_t)attr.mq_msgsize : BATCH_MSG_SIZE;
+        int fit = (int)((r->msgsize - batch_bytes(EMERGENCY_NAME_LENGTH, 0)) / sizeof(batch_entry_t));
+        if (fit < 1) {
+            fprintf(stderr, "La coda non accetta messaggi batch (mq_msgsize %ld)\n", attr.mq_msgsize);
+            return -1;
+        }
+        r->batch_max = (k > 0 && k < fit) ? k : fit;
+
+        r->batches = calloc(MAX_QUEUES, sizeof(batch_t));
+        if (!r->batches) {
+            perror("calloc");
+            return -1;
+        }
+        for (int i = 0; i < r->mq_count; i++) {
+            SAFE_MALLOC(r->batches[i].entries, sizeof(batch_entry_t) * (size_t)r->batch_max);
+        }
+    }
+
+    FILE *fp;
+    SAFE_FOPEN(fp, filename, "r", filename);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    char line[MAX_LINE];
+    int rc = 0, sent = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        char nome[MAX_VAL_LEN];
+        int x, y, delay;
+
+        if (sscanf(line, "%63s %d %d %d", nome, &x, &y, &delay) == 4 &&
+            is_valid_coordinate(x, y) && is_valid_delay(delay) && is_nonempty_string(nome)) {
+            emergency_request_t req;
+            int ok;
+            if (r->shm) {
+                snprintf(req.emergency_name, EMERGENCY_NAME_LENGTH, "%.63s", nome);
+                req.x = x;
+                req.y = y;
+                req.timestamp = time(NULL) + delay;
+                shm_ring_push(r->shm, r->ring, &req);
+                r->sent_msgs++;
+                ok = 0;
+            } else {
+                ok = accoda_batch(r, nome, x, y, delay);
+            }
+            if (ok == 0) sent++;
+            else rc = -1;
+        } else {
+            fprintf(stderr, "Riga non valida: %s", line);
+            rc = -1;
+        }
+    }
+    fclose(fp);
+    for (int i = 0; r->batches && i < r->mq_count; i++)
+        if (invia_batch(r, i) != 0) rc = -1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double secs = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("Inviate %d emergenze in %d messaggi (max %d per messaggio) in %.3f s\n",
+           sent, r->sent_msgs, r->batch_max, secs);
+    return rc;
+}
+
+/* ----------------------------------------------------------------- socket */
+
+static const char *nome_stato(int32_t status) {
+    static const char *nomi[] = { "WAITING", "ASSIGNED", "IN_PROGRESS", "PAUSED", "COMPLETED", "CANCELED", "TIMEOUT" };
+    return status >= 0 && status <= TIMEOUT ? nomi[status] : "non attiva";
+}
+
+/* Stessa sintassi di listen= in env.conf: "tcp:porta" (loopback) o percorso di un socket Unix */
+static int connetti_socket(const char *spec) {
+    int fd;
+    if (strncmp(spec, "tcp:", 4) == 0) {
+        struct sockaddr_in a = { .sin_family = AF_INET, .sin_port = htons((uint16_t)atoi(spec + 4)) };
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr *)&a, sizeof(a)) == 0) return fd;
+    } else {
+        struct sockaddr_un a = { .sun_family = AF_UNIX };
+        if (strlen(spec) >= sizeof(a.sun_path)) return -1;
+        strcpy(a.sun_path, spec);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr *)&a, sizeof(a)) == 0) return fd;
+    }
+    if (fd >= 0) close(fd);
+    return -1;
+}
+
+static int scrivi_tutto(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// Frame: uint32 lunghezza + contenuto
+static int scrivi_frame(int fd, const void *payload, uint32_t len) {
+    if (scrivi_tutto(fd, &len, sizeof(len)) != 0) return -1;
+    return scrivi_tutto(fd, payload, len);
+}
+
+/* Una risposta del server entro timeout_ms: 1 letta, 0 tempo scaduto, -1 connessione chiusa o frame inattesa */
+static int leggi_risposta(int fd, ingest_reply_t *r, int timeout_ms) {
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    int ready = poll(&pfd, 1, timeout_ms < 0 ? 0 : timeout_ms);
+    if (ready == 0) return 0;
+    if (ready < 0) return errno == EINTR ? 0 : -1;
+
+    char buf[sizeof(uint32_t) + sizeof(ingest_reply_t)];
+    size_t got = 0;
+    while (got < sizeof(buf)) { // il resto della frame arriva subito dopo
+        ssize_t n = recv(fd, buf + got, sizeof(buf) - got, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        got += (size_t)n;
+    }
+    uint32_t len;
+    memcpy(&len, buf, sizeof(len));
+    if (len != sizeof(ingest_reply_t)) return -1;
+    memcpy(r, buf + sizeof(len), sizeof(*r));
+    return 1;
+}
+
+static int ms_mancanti(time_t fine) {
+    return (int)(fine - time(NULL)) * 1000;
+}
+
+/* -s: invia una richiesta sul front end a socket (listen= del server) e resta connesso
+ * fino a `attesa` secondi: stampa l'ack con l'id, le transizioni di stato notificate
+ * dal server e, alla fine, la risposta a un'interrogazione di stato per quell'id.
+ * Una notifica per un id diverso vorrebbe dire che il server ha consegnato a questa
+ * connessione le notifiche di un'altra (magari chiusa, con lo stesso slot): errore.
+ */
+static int invia_socket(const char *spec, const char *nome, int x, int y, int delay, int attesa) {
+    int fd = connetti_socket(spec);
+    if (fd < 0) {
+        perror("connect");
+        return -1;
+    }
+    emergency_request_t req;
+    memset(&req, 0, sizeof(req));
+    snprintf(req.emergency_name, EMERGENCY_NAME_LENGTH, "%s", nome);
+    req.x = x;
+    req.y = y;
+    req.timestamp = time(NULL) + delay;
+    if (scrivi_frame(fd, &req, sizeof(req)) != 0) {
+        perror("send");
+        close(fd);
+        return -1;
+    }
+
+    ingest_reply_t r;
+    if (leggi_risposta(fd, &r, 5000) != 1 || r.kind != REPLY_ACK) {
+        fprintf(stderr, "Nessun ack dal server\n");
+        close(fd);
+        return -1;
+    }
+    if (r.status != 0) {
+        printf("Emergenza '%s' scartata dal server\n", req.emergency_name);
+        close(fd);
+        return -1;
+    }
+    uint64_t seq = r.seq;
+    printf("Emergenza '%s' accettata: id %llu\n", req.emergency_name, (unsigned long long)seq);
+
+    int rc = 0, finita = 0;
+    time_t fine = time(NULL) + attesa;
+    while (!finita) {
+        int got = leggi_risposta(fd, &r, ms_mancanti(fine));
+        if (got == 0) break;
+        if (got < 0) {
+            fprintf(stderr, "Connessione chiusa dal server\n");
+            close(fd);
+            return -1;
+        }
+        if (r.seq != seq) {
+            fprintf(stderr, "ERRORE: notifica per l'emergenza %llu, non inviata da questa connessione\n",
+                    (unsigned long long)r.seq);
+            rc = -1;
+            continue;
+        }
+        switch (r.kind) {
+        case REPLY_STATUS:
+            printf("Emergenza %llu: %s\n", (unsigned long long)seq, nome_stato(r.status));
+            finita = r.status == COMPLETED || r.status == CANCELED || r.status == TIMEOUT;
+            break;
+        case REPLY_MERGED:
+            printf("Emergenza %llu: accorpata all'emergenza %llu\n", (unsigned long long)seq, (unsigned long long)r.ref);
+            finita = 1;
+            break;
+        case REPLY_SHED:
+            printf("Emergenza %llu: %s per sovraccarico\n", (unsigned long long)seq, r.status == 0 ? "rimandata" : "respinta");
+            finita = r.status != 0;
+            break;
+        }
+    }
+
+    // Interrogazione finale: -1 (non attiva) se è già terminata
+    status_query_t q = { .magic = QUERY_MAGIC, .seq = seq };
+    if (scrivi_frame(fd, &q, sizeof(q)) != 0) {
+        perror("send");
+        close(fd);
+        return -1;
+    }
+    int got;
+    while ((got = leggi_risposta(fd, &r, 5000)) == 1 && r.kind != REPLY_QUERY) {
+        if (r.seq != seq) {
+            fprintf(stderr, "ERRORE: notifica per l'emergenza %llu, non inviata da questa connessione\n",
+                    (unsigned long long)r.seq);
+            rc = -1;
+        } else if (r.kind == REPLY_STATUS) {
+            printf("Emergenza %llu: %s\n", (unsigned long long)seq, nome_stato(r.status));
+        }
+    }
+    if (got == 1) printf("Stato di %llu: %s\n", (unsigned long long)seq, nome_stato(r.status));
+    else rc = -1;
+    close(fd);
+    return rc;
+}
+
 int main(int argc, char *argv[]) {
     client_res_t res;
     res_init(&res);
@@ -96,12 +469,37 @@ int main(int argc, char *argv[]) {
     serverLog(1, "CLIENT STARTED: PID %d", getpid());
 
     if (argc < 2) {
-        fprintf(stderr, "Uso: %s <nome_emergenza> <x> <y> <ritardo_sec>\n", argv[0]);
-        fprintf(stderr, "   oppure: %s -f <file_input>\n", argv[0]);
+        fprintf(stderr, "Uso: %s [-r] <nome_emergenza> <x> <y> <ritardo_sec>\n", argv[0]);
+        fprintf(stderr, "   oppure: %s [-r] -f <file_input>\n", argv[0]);
+        fprintf(stderr, "   oppure: %s [-r] -b <file_input> [richieste_per_messaggio]\n", argv[0]);
+        fprintf(stderr, "   oppure: %s -s <socket> <nome_emergenza> <x> <y> <ritardo_sec> [attesa_sec]\n", argv[0]);
+        fprintf(stderr, "   -r: shard a rotazione invece che per coordinate\n");
+        fprintf(stderr, "   -s: invio sul front end a socket (listen= del server), con ack, notifiche e interrogazione\n");
         res_cleanup(&res);
         return EXIT_FAILURE;
     }
 
+    // Il front end a socket non usa le code: env.conf non serve
+    if (strcmp(argv[1], "-s") == 0) {
+        int status = -1;
+        if (argc == 7 || argc == 8) {
+            const char *nome = argv[3];
+            int x = atoi(argv[4]);
+            int y = atoi(argv[5]);
+            int delay = atoi(argv[6]);
+            int attesa = argc == 8 ? atoi(argv[7]) : 30;
+            if (!is_nonempty_string(nome) || !is_valid_coordinate(x, y) || !is_valid_delay(delay) || attesa < 0)
+                fprintf(stderr, "Argomenti non validi\n");
+            else
+                status = invia_socket(argv[2], nome, x, y, delay, attesa);
+        } else {
+            fprintf(stderr, "Argomenti non validi\n");
+        }
+        res_cleanup(&res);
+        close_logger();
+        return (status == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     // parsing env
     res.config = parse_env_config("conf/env.conf");
     if (!res.config.queue_name) {
@@ -110,18 +508,49 @@ int main(int argc, char *argv[]) {
         return EXIT_FAILURE;
     }
 
-    // apertura coda POSIX
-    res.mq = mq_open(res.config.queue_name, O_WRONLY);
-    if (res.mq == (mqd_t)-1) {
-        perror("mq_open");
-        res_cleanup(&res);
-        return EXIT_FAILURE;
+    if (res.config.transport == TRANSPORT_SHM) {
+        // anello in memoria condivisa al posto delle code
+        char name[MAX_LINE];
+        shm_region_name(res.config.queue_name, name, sizeof(name));
+        res.shm = shm_region_attach(name);
+        if (!res.shm) {
+            perror("shm_open");
+            res_cleanup(&res);
+            return EXIT_FAILURE;
+        }
+        if (!shm_ring_claim(res.shm, &res.ring)) {
+            fprintf(stderr, "Errore: nessun anello libero in %s\n", name);
+            res_cleanup(&res);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // apertura code POSIX (una per shard)
+    for (int i = 0; i < res.config.queues && !res.shm; i++) {
+        char name[MAX_LINE];
+        env_queue_name(&res.config, i, name, sizeof(name));
+        res.mqs[i] = mq_open(name, O_WRONLY);
+        res.mq_count = i + 1;
+        if (res.mqs[i] == (mqd_t)-1) {
+            perror("mq_open");
+            res_cleanup(&res);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (strcmp(argv[1], "-r") == 0) {
+        res.round_robin = 1;
+        res.next_shard = (unsigned)getpid(); // client diversi partono da shard diversi
+        argv++;
+        argc--;
     }
 
     int status = 0;
 
-    if (strcmp(argv[1], "-f") == 0 && argc == 3) {
-        status = invia_da_file(res.mq, argv[2]);
+    if (argc == 3 && strcmp(argv[1], "-f") == 0) {
+        status = invia_da_file(&res, argv[2]);
+    } else if ((argc == 3 || argc == 4) && strcmp(argv[1], "-b") == 0) {
+        status = invia_da_file_batch(&res, argv[2], argc == 4 ? atoi(argv[3]) : 0);
     } else if (argc == 5) {
         const char *nome = argv[1];
         int x = atoi(argv[2]);
@@ -132,7 +561,7 @@ int main(int argc, char *argv[]) {
             fprintf(stderr, "Argomenti non validi\n");
             status = -1;
         } else {
-            status = invia_emergenza(res.mq, nome, x, y, delay);
+            status = invia_emergenza(&res, nome, x, y, delay);
         }
     } else {
         fprintf(stderr, "Argomenti non validi\n");
@@ -0,0 +1,37 @@
+#!/bin/bash
+# Benchmark dell'invio in blocco (client -b, formato batch): N richieste (default 20000)
+# verso un server avviato su una configurazione temporanea con 4 code.
+# Prima un messaggio per richiesta (-b <file> 1), poi batch pieni (-b <file>).
+# Il tempo è quello del client fino all'ultimo invio: le code sono profonde 10,
+# quindi segue la velocità con cui i listener del server le svuotano.
+# Uso (dopo make): ./client_bench.sh [richieste]   oppure   make bench-batch
+N=${1:-20000}
+ROOT=$(cd "$(dirname "$0")" && pwd)
+DIR=$(mktemp -d)
+SRV=
+trap '[ -n "$SRV" ] && kill -9 $SRV 2>/dev/null; rm -rf "$DIR"' EXIT
+
+mkdir -p "$DIR/conf" "$DIR/cl/conf"
+cp "$ROOT/conf/rescuers.conf" "$ROOT/conf/emergency_types.conf" "$DIR/conf/"
+printf 'queue=client_bench%d\nheight=300\nwidth=400\nqueues=4\n' $$ > "$DIR/conf/env.conf"
+cp "$DIR/conf/env.conf" "$DIR/cl/conf/"
+type=$(sed -n 's/^\[\([^]]*\)\].*/\1/p' "$ROOT/conf/emergency_types.conf" | head -1)
+awk -v n="$N" -v t="$type" 'BEGIN { srand(1); for (i = 0; i < n; i++) printf "%s %d %d 0\n", t, int(rand() * 400), int(rand() * 300) }' > "$DIR/load.txt"
+
+run() { # $1 = etichetta, poi gli argomenti del client
+    (cd "$DIR" && exec "$ROOT/emergenza" "$DIR/conf" > /dev/null 2>&1) &
+    SRV=$!
+    sleep 1
+    local t0 t1 ms
+    t0=$(date +%s%N)
+    (cd "$DIR/cl" && "$ROOT/client" "${@:2}" > /dev/null)
+    t1=$(date +%s%N)
+    ms=$(( (t1 - t0) / 1000000 ))
+    echo "$1: $N requests in $ms ms ($(( N * 1000 / (ms > 0 ? ms : 1) )) req/s)"
+    kill -INT $SRV
+    wait $SRV
+    SRV=
+}
+
+run "one request per message (-b file 1)" -b "$DIR/load.txt" 1
+run "full batches (-b file)              " -b "$DIR/load.txt"
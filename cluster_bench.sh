@@ -0,0 +1,42 @@
+#!/bin/bash
+# Benchmark del cluster (cluster=N in env.conf, exec/cluster.c): le stesse R richieste
+# (default 200 Frana, inviate con client -b) verso un server a processo singolo e
+# poi verso un cluster di N regioni (default 4), con 400 Pompieri sulla mappa 400x300.
+# Per ciascuno conta, dopo W secondi (default 20) dall'invio, le missioni avviate
+# ("rescuers en route") e quelle completate, e ne riporta il ritmo al secondo.
+# Uso (dopo make): ./cluster_bench.sh [regioni] [secondi] [richieste]   oppure   make bench-cluster
+N=${1:-4}
+W=${2:-20}
+R=${3:-200}
+ROOT=$(cd "$(dirname "$0")" && pwd)
+DIR=$(mktemp -d)
+SRV=
+trap '[ -n "$SRV" ] && kill -9 $SRV 2>/dev/null; rm -rf "$DIR"' EXIT
+
+mkdir -p "$DIR/conf" "$DIR/cl/conf"
+printf '[Pompieri][400][50][200;150]\n' > "$DIR/conf/rescuers.conf"
+printf '[Frana] [0] Pompieri:1,5;\n' > "$DIR/conf/emergency_types.conf"
+awk -v n="$R" 'BEGIN { srand(1); for (i = 0; i < n; i++) printf "Frana %d %d 0\n", int(rand() * 400), int(rand() * 300) }' > "$DIR/load.txt"
+
+run() { # $1 = regioni (1 = processo singolo)
+    printf 'queue=cluster_bench%d\nheight=300\nwidth=400\n' $$ > "$DIR/conf/env.conf"
+    [ "$1" -gt 1 ] && echo "cluster=$1" >> "$DIR/conf/env.conf"
+    cp "$DIR/conf/env.conf" "$DIR/cl/conf/"
+    rm -f "$DIR/emergenza.log"
+    (cd "$DIR" && exec "$ROOT/emergenza" "$DIR/conf" > /dev/null 2>&1) &
+    SRV=$!
+    sleep 1.5
+    (cd "$DIR/cl" && "$ROOT/client" -b "$DIR/load.txt" > /dev/null)
+    sleep "$W"
+    local started completed
+    started=$(grep -c 'rescuers en route' "$DIR/emergenza.log")
+    completed=$(grep -c ': COMPLETED' "$DIR/emergenza.log")
+    awk -v n="$1" -v w="$W" -v s="$started" -v c="$completed" 'BEGIN {
+        printf "cluster=%d: after %ds %d missions started (%.1f/s), %d completed (%.1f/s)\n", n, w, s, s / w, c, c / w }'
+    kill -INT $SRV
+    wait $SRV
+    SRV=
+}
+
+run 1
+run "$N"
@@ -0,0 +1,64 @@
+/* confc.c - compila una directory di configurazione in uno snapshot binario
+ * che `emergenza` può caricare direttamente (./emergenza conf/fleet.snap).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "macro.h"
+#include "logger.h"
+#include "utils.h"
+#include "parse_env.h"
+#include "parse_rescuers.h"
+#include "parse_emergency.h"
+#include "parse_snapshot.h"
+
+int main(int argc, char *argv[]) {
+    if (argc > 3) {
+        fprintf(stderr, "Uso: %s [conf_dir] [output.snap]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *conf_dir = (argc > 1) ? argv[1] : "conf";
+    char out[MAX_LINE];
+    if (argc > 2) snprintf(out, sizeof(out), "%s", argv[2]);
+    else snprintf(out, sizeof(out), "%s/fleet.snap", conf_dir);
+
+    init_logger("emergenza.log");
+
+    char filepath[MAX_LINE];
+    snprintf(filepath, sizeof(filepath), "%s/env.conf", conf_dir);
+    env_config_t env = parse_env_config(filepath);
+    if (!env.queue_name) {
+        fprintf(stderr, "Errore: %s non valido\n", filepath);
+        close_logger();
+        return EXIT_FAILURE;
+    }
+
+    snprintf(filepath, sizeof(filepath), "%s/rescuers.conf", conf_dir);
+    rescuers_data_t rescuers = parse_rescuers_config(filepath);
+
+    snprintf(filepath, sizeof(filepath), "%s/emergency_types.conf", conf_dir);
+    emergency_data_t em_data = parse_emergency_types_config(filepath, rescuers.types, rescuers.type_count);
+
+    if (rescuers.twin_count == 0 || em_data.count == 0) {
+        fprintf(stderr, "Errore: configurazione vuota (%d soccorritori, %d emergenze)\n",
+                rescuers.twin_count, em_data.count);
+        close_logger();
+        return EXIT_FAILURE;
+    }
+
+    // env.conf viene incluso come testo: le opzioni restano quelle del parser
+    snprintf(filepath, sizeof(filepath), "%s/env.conf", conf_dir);
+    size_t env_len = 0;
+    const char *env_text = map_file(filepath, &env_len);
+    if (!env_text || snapshot_write(out, env_text, env_len, &rescuers, &em_data) != 0) {
+        perror(out);
+        close_logger();
+        return EXIT_FAILURE;
+    }
+    unmap_file(env_text, env_len);
+    printf("Snapshot %s: %d tipi, %d soccorritori, %d emergenze\n",
+           out, rescuers.type_count, rescuers.twin_count, em_data.count);
+
+    close_logger();
+    return EXIT_SUCCESS;
+}